@@ -1,11 +1,37 @@
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA_256_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/*
+ * Streaming hash state. Bytes are accumulated in buf until a full
+ * chunk is available.
+ */
+struct sha_256 {
+	uint32_t h[8];
+	uint64_t total_len;
+	uint8_t buf[64];
+	size_t buf_len;
+};
+
 void calc_sha_256(uint8_t hash[32], const void *input, size_t len);
+void sha_256_init(struct sha_256 *s);
+void sha_256_write(struct sha_256 *s, const void *input, size_t len);
+void sha_256_close(struct sha_256 *s, uint8_t hash[32]);
+int sha_256_file(uint8_t hash[32], const char *filename);
+long sha_256_files(uint8_t *hashes, const char **filenames, long n);
 
 #define CHUNK_SIZE 64
 #define TOTAL_LEN_LEN 8
 
+/* Number of bytes read from a file at a time. */
+#define READ_SIZE (64 * 1024)
+
 /*
  * ABOUT bool: this file does not use bool in order to be as pre-C99 compatible as possible.
  */
@@ -30,12 +56,12 @@ static const uint32_t k[] = {
 	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-struct buffer_state {
-	const uint8_t * p;
-	size_t len;
-	size_t total_len;
-	int single_one_delivered; /* bool */
-	int total_len_delivered; /* bool */
+/*
+ * Initialize hash values:
+ * (first 32 bits of the fractional parts of the square roots of the first 8 primes 2..19):
+ */
+static const uint32_t h0[] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
 };
 
 static inline uint32_t right_rot(uint32_t value, unsigned int count)
@@ -47,81 +73,14 @@ static inline uint32_t right_rot(uint32_t value, unsigned int count)
 	return value >> count | value << (32 - count);
 }
 
-static void init_buf_state(struct buffer_state * state, const void * input, size_t len)
-{
-	state->p = input;
-	state->len = len;
-	state->total_len = len;
-	state->single_one_delivered = 0;
-	state->total_len_delivered = 0;
-}
-
-/* Return value: bool */
-static int calc_chunk(uint8_t chunk[CHUNK_SIZE], struct buffer_state * state)
-{
-	size_t space_in_chunk;
-
-	if (state->total_len_delivered) {
-		return 0;
-	}
-
-	if (state->len >= CHUNK_SIZE) {
-		memcpy(chunk, state->p, CHUNK_SIZE);
-		state->p += CHUNK_SIZE;
-		state->len -= CHUNK_SIZE;
-		return 1;
-	}
-
-	memcpy(chunk, state->p, state->len);
-	chunk += state->len;
-	space_in_chunk = CHUNK_SIZE - state->len;
-	state->p += state->len;
-	state->len = 0;
-
-	/* If we are here, space_in_chunk is one at minimum. */
-	if (!state->single_one_delivered) {
-		*chunk++ = 0x80;
-		space_in_chunk -= 1;
-		state->single_one_delivered = 1;
-	}
-
-	/*
-	 * Now:
-	 * - either there is enough space left for the total length, and we can conclude,
-	 * - or there is too little space left, and we have to pad the rest of this chunk with zeroes.
-	 * In the latter case, we will conclude at the next invokation of this function.
-	 */
-	if (space_in_chunk >= TOTAL_LEN_LEN) {
-		const size_t left = space_in_chunk - TOTAL_LEN_LEN;
-		size_t len = state->total_len;
-		int i;
-		memset(chunk, 0x00, left);
-		chunk += left;
-
-		/* Storing of len * 8 as a big endian 64-bit without overflow. */
-		chunk[7] = (uint8_t) (len << 3);
-		len >>= 5;
-		for (i = 6; i >= 0; i--) {
-			chunk[i] = (uint8_t) len;
-			len >>= 8;
-		}
-		state->total_len_delivered = 1;
-	} else {
-		memset(chunk, 0x00, space_in_chunk);
-	}
-
-	return 1;
-}
+/*============================================================
+ *================== Portable Compression ====================
+ *============================================================*/
 
 /*
- * Limitations:
- * - Since input is a pointer in RAM, the data to hash should be in RAM, which could be a problem
- *   for large data sizes.
- * - SHA algorithms theoretically operate on bit strings. However, this implementation has no support
- *   for bit string lengths that are not multiples of eight, and it really operates on arrays of bytes.
- *   In particular, the len parameter is a number of bytes.
+ * Compress nchunks consecutive 64-byte chunks into the hash value h.
  */
-void calc_sha_256(uint8_t hash[32], const void * input, size_t len)
+static void compress_portable(uint32_t h[8], const uint8_t *chunks, size_t nchunks)
 {
 	/*
 	 * Note 1: All integers (expect indexes) are 32-bit unsigned integers and addition is calculated modulo 2^32.
@@ -131,25 +90,12 @@ void calc_sha_256(uint8_t hash[32], const void * input, size_t len)
 	 *     and when parsing message block data from bytes to words, for example,
 	 *     the first word of the input message "abc" after padding is 0x61626380
 	 */
-
-	/*
-	 * Initialize hash values:
-	 * (first 32 bits of the fractional parts of the square roots of the first 8 primes 2..19):
-	 */
-	uint32_t h[] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
 	unsigned i, j;
 
-	/* 512-bit chunks is what we will operate on. */
-	uint8_t chunk[64];
-
-	struct buffer_state state;
-
-	init_buf_state(&state, input, len);
-
-	while (calc_chunk(chunk, &state)) {
+	for (; nchunks > 0; nchunks--) {
 		uint32_t ah[8];
 
-		const uint8_t *p = chunk;
+		const uint8_t *p = chunks;
 
 		/* Initialize working variables to current hash value: */
 		for (i = 0; i < 8; i++)
@@ -206,14 +152,488 @@ void calc_sha_256(uint8_t hash[32], const void * input, size_t len)
 		/* Add the compressed chunk to the current hash value: */
 		for (i = 0; i < 8; i++)
 			h[i] += ah[i];
+
+		chunks += CHUNK_SIZE;
+	}
+}
+
+#ifdef SHA_256_X86
+
+/*============================================================
+ *================== SHA-NI Compression ======================
+ *============================================================*/
+
+/*
+ * Compress using the x86 SHA extensions. The hash value is kept in
+ * the ABEF/CDGH register layout expected by sha256rnds2, and each
+ * sha256rnds2 instruction performs two rounds.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+static void compress_shani(uint32_t h[8], const uint8_t *chunks, size_t nchunks)
+{
+	const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, tmp;
+	int i;
+
+	tmp = _mm_loadu_si128((const __m128i *) &h[0]);
+	state1 = _mm_loadu_si128((const __m128i *) &h[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);            /* CDAB */
+	state1 = _mm_shuffle_epi32(state1, 0x1B);      /* EFGH */
+	state0 = _mm_alignr_epi8(tmp, state1, 8);      /* ABEF */
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);   /* CDGH */
+
+	for (; nchunks > 0; nchunks--) {
+		const __m128i abef = state0;
+		const __m128i cdgh = state1;
+		__m128i w[16];
+
+		for (i = 0; i < 16; i++) {
+			__m128i msg;
+			if (i < 4) {
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (chunks + 16 * i)), byte_swap);
+			} else {
+				/* Compute the next four words of the message schedule. */
+				tmp = _mm_alignr_epi8(w[i - 1], w[i - 2], 4);
+				msg = _mm_add_epi32(_mm_sha256msg1_epu32(w[i - 4], w[i - 3]), tmp);
+				w[i] = _mm_sha256msg2_epu32(msg, w[i - 1]);
+			}
+			msg = _mm_add_epi32(w[i], _mm_loadu_si128((const __m128i *) &k[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+		chunks += CHUNK_SIZE;
 	}
 
+	tmp = _mm_shuffle_epi32(state0, 0x1B);         /* FEBA */
+	state1 = _mm_shuffle_epi32(state1, 0xB1);      /* DCHG */
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);   /* DCBA */
+	state1 = _mm_alignr_epi8(state1, tmp, 8);      /* HGFE */
+
+	_mm_storeu_si128((__m128i *) &h[0], state0);
+	_mm_storeu_si128((__m128i *) &h[4], state1);
+}
+
+/*============================================================
+ *================ AVX2 Multi-Buffer Compression =============
+ *============================================================*/
+
+/*
+ * Compress nchunks chunks from each of 8 independent messages at once.
+ * Each 32-bit lane of a vector holds the value for one message.
+ */
+#define ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+__attribute__((target("avx2")))
+static void compress_avx2_x8(uint32_t *hs[8], const uint8_t *chunks[8], size_t nchunks)
+{
+	const __m256i byte_swap = _mm256_set_epi8(
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	__m256i h[8];
+	size_t n;
+	int i, j;
+
+	for (i = 0; i < 8; i++)
+		h[i] = _mm256_setr_epi32(hs[0][i], hs[1][i], hs[2][i], hs[3][i],
+		                         hs[4][i], hs[5][i], hs[6][i], hs[7][i]);
+
+	for (n = 0; n < nchunks; n++) {
+		__m256i w[16];
+		__m256i ah[8];
+
+		/* Gather word j of the current chunk of each message. */
+		for (j = 0; j < 16; j++) {
+			uint32_t words[8];
+			for (i = 0; i < 8; i++)
+				memcpy(&words[i], chunks[i] + n * CHUNK_SIZE + 4 * j, 4);
+			w[j] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) words), byte_swap);
+		}
+
+		for (i = 0; i < 8; i++)
+			ah[i] = h[i];
+
+		for (i = 0; i < 64; i++) {
+			__m256i wi;
+			if (i < 16) {
+				wi = w[i];
+			} else {
+				const __m256i w1 = w[(i + 1) & 0xf];
+				const __m256i w14 = w[(i + 14) & 0xf];
+				const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w1, 7), ROTR8(w1, 18)), _mm256_srli_epi32(w1, 3));
+				const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w14, 17), ROTR8(w14, 19)), _mm256_srli_epi32(w14, 10));
+				wi = _mm256_add_epi32(_mm256_add_epi32(w[i & 0xf], s0), _mm256_add_epi32(w[(i + 9) & 0xf], s1));
+				w[i & 0xf] = wi;
+			}
+			{
+				const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(ah[4], 6), ROTR8(ah[4], 11)), ROTR8(ah[4], 25));
+				const __m256i ch = _mm256_xor_si256(_mm256_and_si256(ah[4], ah[5]), _mm256_andnot_si256(ah[4], ah[6]));
+				const __m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(ah[7], s1), _mm256_add_epi32(ch, wi)),
+				                                       _mm256_set1_epi32((int) k[i]));
+				const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(ah[0], 2), ROTR8(ah[0], 13)), ROTR8(ah[0], 22));
+				const __m256i maj = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(ah[0], ah[1]), _mm256_and_si256(ah[0], ah[2])),
+				                                     _mm256_and_si256(ah[1], ah[2]));
+				const __m256i temp2 = _mm256_add_epi32(s0, maj);
+
+				ah[7] = ah[6];
+				ah[6] = ah[5];
+				ah[5] = ah[4];
+				ah[4] = _mm256_add_epi32(ah[3], temp1);
+				ah[3] = ah[2];
+				ah[2] = ah[1];
+				ah[1] = ah[0];
+				ah[0] = _mm256_add_epi32(temp1, temp2);
+			}
+		}
+
+		for (i = 0; i < 8; i++)
+			h[i] = _mm256_add_epi32(h[i], ah[i]);
+	}
+
+	for (i = 0; i < 8; i++) {
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i *) lanes, h[i]);
+		for (j = 0; j < 8; j++)
+			hs[j][i] = lanes[j];
+	}
+}
+
+#undef ROTR8
+
+#endif
+
+/*============================================================
+ *==================== Runtime Dispatch ======================
+ *============================================================*/
+
+typedef void (*compress_fn)(uint32_t h[8], const uint8_t *chunks, size_t nchunks);
+
+static compress_fn compress = 0;
+static int multi_buffer = 0; /* bool */
+
+/*
+ * Select the fastest available implementation the first time a hash
+ * is computed.
+ */
+static void select_implementation(void)
+{
+	compress = compress_portable;
+	multi_buffer = 0;
+#ifdef SHA_256_X86
+	{
+		unsigned int eax, ebx, ecx, edx;
+		unsigned int ebx7 = 0;
+		int sse41 = 0, ssse3 = 0, avx = 0;
+		if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+			ssse3 = (ecx >> 9) & 1;
+			sse41 = (ecx >> 19) & 1;
+			/* AVX registers must also be enabled by the operating system (OSXSAVE and XCR0). */
+			if ((ecx >> 27) & 1 && (ecx >> 28) & 1) {
+				unsigned int xcr0_lo, xcr0_hi;
+				__asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+				avx = (xcr0_lo & 6) == 6;
+			}
+		}
+		if (__get_cpuid_max(0, 0) >= 7) {
+			__cpuid_count(7, 0, eax, ebx7, ecx, edx);
+		}
+		if (((ebx7 >> 29) & 1) && sse41 && ssse3)
+			compress = compress_shani;
+		else if (((ebx7 >> 5) & 1) && avx)
+			multi_buffer = 1;
+	}
+#endif
+}
+
+static void ensure_implementation(void)
+{
+	if (!compress)
+		select_implementation();
+}
+
+/*============================================================
+ *===================== Streaming API ========================
+ *============================================================*/
+
+void sha_256_init(struct sha_256 *s)
+{
+	ensure_implementation();
+	memcpy(s->h, h0, sizeof(h0));
+	s->total_len = 0;
+	s->buf_len = 0;
+}
+
+void sha_256_write(struct sha_256 *s, const void *input, size_t len)
+{
+	const uint8_t *p = input;
+	s->total_len += len;
+
+	/* Complete a partially filled chunk first. */
+	if (s->buf_len > 0) {
+		size_t n = CHUNK_SIZE - s->buf_len;
+		if (n > len)
+			n = len;
+		memcpy(s->buf + s->buf_len, p, n);
+		s->buf_len += n;
+		p += n;
+		len -= n;
+		if (s->buf_len < CHUNK_SIZE)
+			return;
+		compress(s->h, s->buf, 1);
+		s->buf_len = 0;
+	}
+
+	/* Compress full chunks directly from the input. */
+	if (len >= CHUNK_SIZE) {
+		size_t nchunks = len / CHUNK_SIZE;
+		compress(s->h, p, nchunks);
+		p += nchunks * CHUNK_SIZE;
+		len -= nchunks * CHUNK_SIZE;
+	}
+
+	memcpy(s->buf, p, len);
+	s->buf_len = len;
+}
+
+void sha_256_close(struct sha_256 *s, uint8_t hash[32])
+{
+	uint64_t len = s->total_len;
+	unsigned i, j;
+
+	/* Append the single one bit, then zeroes up to the total length. */
+	s->buf[s->buf_len++] = 0x80;
+	if (s->buf_len > CHUNK_SIZE - TOTAL_LEN_LEN) {
+		memset(s->buf + s->buf_len, 0x00, CHUNK_SIZE - s->buf_len);
+		compress(s->h, s->buf, 1);
+		s->buf_len = 0;
+	}
+	memset(s->buf + s->buf_len, 0x00, CHUNK_SIZE - TOTAL_LEN_LEN - s->buf_len);
+
+	/* Storing of len * 8 as a big endian 64-bit without overflow. */
+	s->buf[63] = (uint8_t) (len << 3);
+	len >>= 5;
+	for (i = 62; i >= 56; i--) {
+		s->buf[i] = (uint8_t) len;
+		len >>= 8;
+	}
+	compress(s->h, s->buf, 1);
+
 	/* Produce the final hash value (big-endian): */
 	for (i = 0, j = 0; i < 8; i++)
 	{
-		hash[j++] = (uint8_t) (h[i] >> 24);
-		hash[j++] = (uint8_t) (h[i] >> 16);
-		hash[j++] = (uint8_t) (h[i] >> 8);
-		hash[j++] = (uint8_t) h[i];
+		hash[j++] = (uint8_t) (s->h[i] >> 24);
+		hash[j++] = (uint8_t) (s->h[i] >> 16);
+		hash[j++] = (uint8_t) (s->h[i] >> 8);
+		hash[j++] = (uint8_t) s->h[i];
 	}
 }
+
+/*
+ * SHA algorithms theoretically operate on bit strings. However, this implementation has no support
+ * for bit string lengths that are not multiples of eight, and it really operates on arrays of bytes.
+ * In particular, the len parameter is a number of bytes.
+ */
+void calc_sha_256(uint8_t hash[32], const void *input, size_t len)
+{
+	struct sha_256 s;
+	sha_256_init(&s);
+	sha_256_write(&s, input, len);
+	sha_256_close(&s, hash);
+}
+
+/*============================================================
+ *======================= File API ===========================
+ *============================================================*/
+
+/*
+ * Hash the contents of the given file, READ_SIZE bytes at a time.
+ * Returns 0 on success and -1 if the file could not be read.
+ */
+int sha_256_file(uint8_t hash[32], const char *filename)
+{
+	static uint8_t buffer[READ_SIZE];
+	struct sha_256 s;
+	size_t n;
+	int failed;
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+		return -1;
+
+	sha_256_init(&s);
+	while ((n = fread(buffer, 1, READ_SIZE, f)) > 0)
+		sha_256_write(&s, buffer, n);
+	failed = ferror(f);
+	fclose(f);
+	if (failed)
+		return -1;
+
+	sha_256_close(&s, hash);
+	return 0;
+}
+
+#ifdef SHA_256_X86
+
+/*
+ * One of the 8 messages being hashed by the multi-buffer implementation.
+ */
+struct lane {
+	FILE *f;
+	long index;
+	struct sha_256 s;
+	uint8_t buf[READ_SIZE];
+	size_t pos;
+	size_t len;
+	int eof; /* bool */
+};
+
+/*
+ * Refill the lane's buffer, keeping any unconsumed bytes.
+ * Returns 0 on success and -1 on a read error.
+ */
+static int refill_lane(struct lane *l)
+{
+	size_t n;
+	memmove(l->buf, l->buf + l->pos, l->len - l->pos);
+	l->len -= l->pos;
+	l->pos = 0;
+	n = fread(l->buf + l->len, 1, READ_SIZE - l->len, l->f);
+	l->len += n;
+	if (n == 0) {
+		if (ferror(l->f))
+			return -1;
+		l->eof = 1;
+	}
+	return 0;
+}
+
+/*
+ * Hash the files in groups of 8 using the multi-buffer implementation.
+ * Whenever a file runs out of full chunks, its remaining bytes are hashed
+ * with the single-buffer implementation, and the next file takes its lane.
+ * Returns the index of the first file that could not be read, or -1.
+ */
+static long sha_256_files_x8(uint8_t *hashes, const char **filenames, long n)
+{
+	static struct lane lanes[8];
+	long next = 0;
+	long failed = -1;
+	int active = 0;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		lanes[i].f = 0;
+
+	for (;;) {
+		/* Assign files to empty lanes. */
+		for (i = 0; i < 8 && failed < 0; i++) {
+			struct lane *l = &lanes[i];
+			if (l->f || next >= n)
+				continue;
+			l->f = fopen(filenames[next], "rb");
+			if (!l->f) {
+				failed = next;
+				break;
+			}
+			l->index = next++;
+			l->pos = 0;
+			l->len = 0;
+			l->eof = 0;
+			sha_256_init(&l->s);
+			active++;
+		}
+		if (failed >= 0 || active == 0)
+			break;
+
+		/* Make sure every lane has a full chunk, or is at the end of its file. */
+		for (i = 0; i < 8 && failed < 0; i++) {
+			struct lane *l = &lanes[i];
+			if (l->f && !l->eof && l->len - l->pos < CHUNK_SIZE)
+				if (refill_lane(l))
+					failed = l->index;
+		}
+		if (failed >= 0)
+			break;
+
+		if (active == 8) {
+			size_t nchunks = (size_t) -1;
+			for (i = 0; i < 8; i++) {
+				size_t c = (lanes[i].len - lanes[i].pos) / CHUNK_SIZE;
+				if (c < nchunks)
+					nchunks = c;
+			}
+			if (nchunks > 0) {
+				uint32_t *hs[8];
+				const uint8_t *chunks[8];
+				for (i = 0; i < 8; i++) {
+					hs[i] = lanes[i].s.h;
+					chunks[i] = lanes[i].buf + lanes[i].pos;
+				}
+				compress_avx2_x8(hs, chunks, nchunks);
+				for (i = 0; i < 8; i++) {
+					lanes[i].pos += nchunks * CHUNK_SIZE;
+					lanes[i].s.total_len += nchunks * CHUNK_SIZE;
+				}
+				continue;
+			}
+		}
+
+		/*
+		 * Not enough lanes have full chunks. Finish the lanes that are
+		 * at the end of their file, or every lane once no files remain.
+		 */
+		for (i = 0; i < 8 && failed < 0; i++) {
+			struct lane *l = &lanes[i];
+			if (!l->f)
+				continue;
+			if (!l->eof && next < n)
+				continue;
+			for (;;) {
+				sha_256_write(&l->s, l->buf + l->pos, l->len - l->pos);
+				l->pos = l->len;
+				if (l->eof)
+					break;
+				if (refill_lane(l)) {
+					failed = l->index;
+					break;
+				}
+			}
+			if (failed >= 0)
+				break;
+			sha_256_close(&l->s, hashes + 32 * l->index);
+			fclose(l->f);
+			l->f = 0;
+			active--;
+		}
+		if (failed >= 0)
+			break;
+	}
+
+	for (i = 0; i < 8; i++)
+		if (lanes[i].f)
+			fclose(lanes[i].f);
+	return failed;
+}
+
+#endif
+
+/*
+ * Hash each of the n files, storing the 32-byte hash of file i at
+ * hashes + 32 * i. Returns the index of the first file that could not
+ * be read, or -1 if all files were hashed.
+ */
+long sha_256_files(uint8_t *hashes, const char **filenames, long n)
+{
+	long i;
+	ensure_implementation();
+#ifdef SHA_256_X86
+	if (multi_buffer && n > 1)
+		return sha_256_files_x8(hashes, filenames, n);
+#endif
+	for (i = 0; i < n; i++)
+		if (sha_256_file(hashes + 32 * i, filenames[i]))
+			return i;
+	return -1;
+}
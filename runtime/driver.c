@@ -9,6 +9,11 @@
 #else
   #include<sys/wait.h>
   #include<sys/mman.h>
+  #include<sys/socket.h>
+  #include<sys/un.h>
+#endif
+#ifdef PLATFORM_OS_X
+  #include<mach-o/dyld.h>
 #endif
 #include<stdint.h>
 #include<stdbool.h>
@@ -100,6 +105,7 @@ typedef struct{
 typedef struct{
   stz_int pool_index;
   stz_int mark;
+  stz_long reserved;
   StackFrame frames[];
 } StackFrameHeader;
 
@@ -230,6 +236,50 @@ stz_long file_write_block (FILE* f, char* data, stz_long len) {
   }
 #endif
 
+//     Executable Path
+//     ===============
+//Return the absolute path of the running executable, or null if
+//it cannot be determined.
+#if defined(PLATFORM_LINUX)
+  stz_byte* current_executable_path (){
+    return STZ_STR(realpath("/proc/self/exe", 0));
+  }
+#endif
+
+#if defined(PLATFORM_OS_X)
+  stz_byte* current_executable_path (){
+    //Retrieve the size of the path first.
+    uint32_t size = 0;
+    _NSGetExecutablePath(NULL, &size);
+    char* path = (char*)stz_malloc(size);
+    if(_NSGetExecutablePath(path, &size) != 0){
+      stz_free(path);
+      return NULL;
+    }
+
+    //The path may contain symbolic links.
+    char* resolved = realpath(path, 0);
+    stz_free(path);
+    return STZ_STR(resolved);
+  }
+#endif
+
+#if defined(PLATFORM_WINDOWS)
+  stz_byte* current_executable_path (){
+    char* path = (char*)stz_malloc(MAX_PATH);
+    DWORD numchars = GetModuleFileName(NULL, path, MAX_PATH);
+
+    // Return null if the path does not fit.
+    if(numchars == 0 || numchars == MAX_PATH){
+      stz_free(path);
+      return NULL;
+    }
+
+    //Return the path
+    return STZ_STR(path);
+  }
+#endif
+
 #ifdef PLATFORM_WINDOWS
 stz_int symlink(const stz_byte* target, const stz_byte* linkpath) {
   DWORD attributes, flags;
@@ -361,6 +411,16 @@ stz_long file_time_modified (const stz_byte* filename){
   return 0;
 }
 
+//             File Size
+//             =========
+
+stz_long file_size (const stz_byte* filename){
+  struct stat attrib;
+  if(stat(C_CSTR(filename), &attrib) == 0)
+    return (stz_long)attrib.st_size;
+  return -1;
+}
+
 #ifdef FMALLOC
 //============================================================
 //======================= Free List ==========================
@@ -565,6 +625,72 @@ stz_int sleep_us (stz_long us){
   return (stz_int)nanosleep(&t1, &t2);
 }
 
+//============================================================
+//==================== Profile Counters ======================
+//============================================================
+
+//Programs compiled with -instrument call stz_profile_count on entry
+//to every function, with a key identifying the function. The counts
+//are kept in an open-addressing hash table, and are written to the
+//file named by STANZA_PROFILE (default: stanza.profile) when the
+//program exits. Key 0 marks an empty slot.
+
+static stz_long* profile_keys = NULL;
+static stz_long* profile_counts = NULL;
+static stz_long profile_capacity = 0;
+static stz_long profile_size = 0;
+
+static void write_profile (void) {
+  const char* filename = getenv("STANZA_PROFILE");
+  if(filename == NULL) filename = "stanza.profile";
+  FILE* f = fopen(filename, "w");
+  if(f == NULL){
+    fprintf(stderr, "Could not write profile to %s.\n", filename);
+    return;
+  }
+  fprintf(f, "stanza-profile 1\n");
+  for(stz_long i=0; i<profile_capacity; i++)
+    if(profile_keys[i] != 0)
+      fprintf(f, "%lld %lld\n", (long long)profile_keys[i], (long long)profile_counts[i]);
+  fclose(f);
+}
+
+static stz_long* profile_slot (stz_long* keys, stz_long capacity, stz_long key) {
+  stz_long i = (stz_long)((unsigned long long)key % (unsigned long long)capacity);
+  while(keys[i] != 0 && keys[i] != key)
+    i = (i + 1) % capacity;
+  return &keys[i];
+}
+
+static void grow_profile_table (void) {
+  stz_long capacity = profile_capacity == 0 ? 1024 : profile_capacity * 2;
+  stz_long* keys = calloc(capacity, sizeof(stz_long));
+  stz_long* counts = calloc(capacity, sizeof(stz_long));
+  for(stz_long i=0; i<profile_capacity; i++){
+    if(profile_keys[i] != 0){
+      stz_long* slot = profile_slot(keys, capacity, profile_keys[i]);
+      *slot = profile_keys[i];
+      counts[slot - keys] = profile_counts[i];
+    }
+  }
+  if(profile_capacity == 0) atexit(write_profile);
+  free(profile_keys);
+  free(profile_counts);
+  profile_keys = keys;
+  profile_counts = counts;
+  profile_capacity = capacity;
+}
+
+void stz_profile_count (stz_long key) {
+  if(2 * (profile_size + 1) > profile_capacity) grow_profile_table();
+  stz_long* slot = profile_slot(profile_keys, profile_capacity, key);
+  if(*slot == 0){
+    *slot = key;
+    profile_size++;
+  }
+  profile_counts[slot - profile_keys]++;
+}
+
 //============================================================
 //================= Stanza Memory Allocator ==================
 //============================================================
@@ -633,6 +759,28 @@ void stz_memory_resize (void* p, stz_long old_size, stz_long new_size) {
   protect((char*)p + min_size, max_size - min_size, prot);
 }
 
+//Allocates a segment of memory for a stack that is min_size allocated,
+//and can be resized up to max_size. Stacks are readable and writable
+//but never executable.
+//The whole segment is mapped at once, so that each stack occupies a
+//single mapping. Its pages are only backed by memory once they are
+//touched, so min_size does not need to be committed separately.
+void* stz_stack_map (stz_long min_size, stz_long max_size) {
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  #ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+  #endif
+  void* p = mmap(NULL, (size_t)max_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (p == MAP_FAILED) exit_with_error();
+  return p;
+}
+
+//Resizes the given stack segment.
+//Nothing needs to be done, as the whole segment is already mapped by
+//stz_stack_map.
+void stz_stack_resize (void* p, stz_long old_size, stz_long new_size) {
+}
+
 #endif
 
 //============================================================
@@ -688,6 +836,41 @@ void stz_memory_resize (void* p, stz_long old_size, stz_long new_size) {
   }
 }
 
+//Allocates a segment of memory for a stack that is min_size allocated,
+//and can be resized up to max_size. Stacks are readable and writable
+//but never executable.
+void* stz_stack_map (stz_long min_size, stz_long max_size) {
+  // Reserve the max size with no access
+  void* p = VirtualAlloc(NULL, (SIZE_T)max_size, MEM_RESERVE, PAGE_NOACCESS);
+  if (p == NULL) exit_with_error();
+
+  // Commit the min size with RW access.
+  p = VirtualAlloc(p, (SIZE_T)min_size, MEM_COMMIT, PAGE_READWRITE);
+  if (p == NULL) exit_with_error();
+
+  // Return the reserved and committed pointer.
+  return p;
+}
+
+//Resizes the given stack segment.
+//old_size is assumed to be the size that is already allocated.
+//new_size is the size that we desired to be allocated, and
+//must be a multiple of the system page size.
+void stz_stack_resize (void* p, stz_long old_size, stz_long new_size) {
+  //Case: if growing the allocated size.
+  if (new_size > old_size) {
+    // Growing the allocation: commit all memory pages from the old limit to the new limit.
+    if (!VirtualAlloc((char*)p + old_size, (SIZE_T)(new_size - old_size), MEM_COMMIT, PAGE_READWRITE))
+      exit_with_error();
+  }
+  //Case: if shrinking the allocated size.
+  else if(new_size < old_size) {
+    // Shrinking the allocation: decommit all memory pages from the new limit to the old limit.
+    if (!VirtualFree((char*)p + new_size, (SIZE_T)(old_size - new_size), MEM_DECOMMIT))
+      exit_with_error();
+  }
+}
+
 #endif
 
 //============================================================
@@ -1047,10 +1230,42 @@ static int delete_process_pipe (FILE* fd, char* pipe_name, char* suffix) {
   return 0;
 }
 
+//SIGPIPE is ignored while the input pipe of a child process is open,
+//so that a child that exits without reading all of its input does not
+//terminate this process. Writing to the pipe fails with EPIPE
+//instead. The previous disposition is restored once all input pipes
+//are closed.
+static int open_input_pipes = 0;
+static struct sigaction saved_sigpipe_action;
+
+static void ignore_sigpipe () {
+  if (open_input_pipes++ == 0) {
+    struct sigaction ignore;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &saved_sigpipe_action);
+  }
+}
+
+static void restore_sigpipe () {
+  if (--open_input_pipes == 0)
+    sigaction(SIGPIPE, &saved_sigpipe_action, NULL);
+}
+
+//Closing the pipe flushes its buffer, so SIGPIPE is restored only
+//afterwards.
+static int delete_input_pipe (FILE* input, char* pipe_name) {
+  if (input == NULL) return 0;
+  int res = delete_process_pipe(input, pipe_name, "_in");
+  restore_sigpipe();
+  return res;
+}
+
 stz_int delete_process_pipes (FILE* input, FILE* output, FILE* error, stz_int pipeid) {
   char pipe_name[80];
   make_pipe_name(pipe_name, (int)pipeid);
-  if (delete_process_pipe(input,  pipe_name, "_in") < 0)
+  if (delete_input_pipe(input, pipe_name) < 0)
     return -1;
   if (delete_process_pipe(output, pipe_name, "_out") < 0)
     return -1;
@@ -1059,6 +1274,14 @@ stz_int delete_process_pipes (FILE* input, FILE* output, FILE* error, stz_int pi
   return 0;
 }
 
+//Closes the input pipe of the process, so that the process reads
+//the end of its input.
+stz_int close_process_input (FILE* input, stz_int pipeid) {
+  char pipe_name[80];
+  make_pipe_name(pipe_name, (int)pipeid);
+  return delete_input_pipe(input, pipe_name);
+}
+
 stz_int launch_process(stz_byte* file, stz_byte** argvs, stz_int input,
                        stz_int output, stz_int error, stz_int pipeid,
                        stz_byte* working_dir, Process* process) {
@@ -1104,6 +1327,7 @@ stz_int launch_process(stz_byte* file, stz_byte** argvs, stz_int input,
     RETURN_NEG(fd)
     fin = fdopen(fd, "w");
     if(fin == NULL) return -1;
+    ignore_sigpipe();
   }
   FILE* fout = NULL;
   if(pipe_sources[PROCESS_OUT] >= 0){
@@ -1151,6 +1375,83 @@ void retrieve_process_state (stz_long pid, ProcessState* s, stz_int wait_for_ter
   //Read back process state
   read_process_state(launcher_out, s);
 }
+
+//Forcibly terminates the process. Its final state is still
+//collected through retrieve_process_state.
+stz_int terminate_process (stz_long pid){
+  return kill((pid_t)pid, SIGKILL);
+}
+
+//============================================================
+//===================== Local Sockets ========================
+//============================================================
+
+static int local_address (const stz_byte* path, struct sockaddr_un* addr){
+  if(strlen(C_CSTR(path)) >= sizeof(addr->sun_path)){
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, C_CSTR(path));
+  return 0;
+}
+
+//Creates a Unix domain socket listening at the given path.
+//Returns the socket, or -1 if it could not be created.
+stz_int open_local_server (const stz_byte* path){
+  struct sockaddr_un addr;
+  if(local_address(path, &addr) < 0) return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0) return -1;
+  if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0){
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  //A client that disconnects early must not terminate the server.
+  signal(SIGPIPE, SIG_IGN);
+  return fd;
+}
+
+//Blocks until a client connects. Returns the connection, or -1.
+stz_int accept_local_connection (stz_int server){
+  int fd;
+  do { fd = accept(server, NULL, NULL); } while(fd < 0 && errno == EINTR);
+  return fd;
+}
+
+//Connects to the server listening at the given path.
+//Returns the connection, or -1.
+stz_int connect_local_server (const stz_byte* path){
+  struct sockaddr_un addr;
+  if(local_address(path, &addr) < 0) return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0) return -1;
+  if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  return fd;
+}
+
+//Returns a stream for reading from or writing to the connection.
+//Each stream owns a duplicate of the socket, so the connection is
+//closed once both streams and the original socket are closed.
+FILE* open_socket_stream (stz_int fd, stz_int write){
+  int dupfd = dup(fd);
+  if(dupfd < 0) return NULL;
+  FILE* f = fdopen(dupfd, write ? "w" : "r");
+  if(f == NULL) close(dupfd);
+  return f;
+}
+
+stz_int close_socket (stz_int fd){
+  return close(fd);
+}
 #else
 #include "process-win32.c"
 //============================================================
@@ -1184,6 +1485,7 @@ static uint64_t alloc_stack (VMInit* init){
   StackFrameHeader* frameheader = (StackFrameHeader*)stz_malloc(size);
   frameheader->pool_index = -1;
   frameheader->mark = 0;
+  frameheader->reserved = 0;
   stack->size = initial_stack_size;
   stack->frames = frameheader->frames;
   stack->stack_pointer = NULL;
@@ -74,6 +74,39 @@ END:
   *s = state;
 }
 
+stz_int terminate_process (stz_long pid) {
+  HANDLE process = OpenProcess(PROCESS_TERMINATE, FALSE, (DWORD)pid);
+  if (process == NULL) return -1;
+  BOOL success = TerminateProcess(process, 1);
+  CloseHandle(process);
+  return success ? 0 : -1;
+}
+
+//Local sockets are not yet supported on Windows.
+stz_int open_local_server (const stz_byte* path) {
+  SetLastError(ERROR_NOT_SUPPORTED);
+  return -1;
+}
+
+stz_int accept_local_connection (stz_int server) {
+  SetLastError(ERROR_NOT_SUPPORTED);
+  return -1;
+}
+
+stz_int connect_local_server (const stz_byte* path) {
+  SetLastError(ERROR_NOT_SUPPORTED);
+  return -1;
+}
+
+FILE* open_socket_stream (stz_int fd, stz_int write) {
+  SetLastError(ERROR_NOT_SUPPORTED);
+  return NULL;
+}
+
+stz_int close_socket (stz_int fd) {
+  return 0;
+}
+
 typedef enum {
   PIPE_IN,
   PIPE_OUT
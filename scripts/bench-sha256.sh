@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+
+# Checks each SHA-256 implementation against the others and reports
+# its throughput on large inputs.
+# USAGES:
+# ./scripts/bench-sha256.sh
+
+mkdir -p build
+gcc -std=gnu99 -O3 tests/sha256-bench.c -o build/sha256-bench
+./build/sha256-bench build
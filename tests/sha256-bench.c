@@ -0,0 +1,226 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+#include<time.h>
+
+//Compile the implementation directly so that each compression
+//function can be tested and timed individually.
+#include "../core/sha256.c"
+
+//============================================================
+//===================== Utilities ============================
+//============================================================
+
+static double now_s (void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void to_hex (const uint8_t hash[32], char out[65]) {
+  for(int i=0; i<32; i++)
+    sprintf(out + 2*i, "%02x", hash[i]);
+}
+
+static int failures = 0;
+
+static void expect_hash (const char* name, const uint8_t hash[32], const char* expected) {
+  char hex[65];
+  to_hex(hash, hex);
+  if(strcmp(hex, expected) != 0){
+    printf("FAIL %s: got %s, expected %s\n", name, hex, expected);
+    failures++;
+  }
+}
+
+static void fill_random (uint8_t* data, size_t len) {
+  uint32_t x = 12345;
+  for(size_t i=0; i<len; i++){
+    x = x * 1103515245 + 12345;
+    data[i] = (uint8_t)(x >> 16);
+  }
+}
+
+//============================================================
+//================== Implementations =========================
+//============================================================
+
+typedef struct {
+  const char* name;
+  compress_fn fn;
+  int available;
+} Impl;
+
+static Impl impls[3];
+static int nimpls = 0;
+
+static void detect_impls (void) {
+  select_implementation();
+  impls[nimpls++] = (Impl){"portable", compress_portable, 1};
+#ifdef SHA_256_X86
+  impls[nimpls++] = (Impl){"sha-ni", compress_shani, compress == compress_shani};
+#endif
+}
+
+//============================================================
+//====================== Tests ===============================
+//============================================================
+
+static void test_vectors (Impl* impl) {
+  uint8_t hash[32];
+  compress = impl->fn;
+  calc_sha_256(hash, "", 0);
+  expect_hash(impl->name, hash, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  calc_sha_256(hash, "abc", 3);
+  expect_hash(impl->name, hash, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  const char* s448 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  calc_sha_256(hash, s448, strlen(s448));
+  expect_hash(impl->name, hash, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  //One million 'a's, written in uneven pieces.
+  struct sha_256 s;
+  char as[1000];
+  memset(as, 'a', sizeof(as));
+  sha_256_init(&s);
+  for(int i=0; i<1000; i++){
+    sha_256_write(&s, as, 7);
+    sha_256_write(&s, as, 993);
+  }
+  sha_256_close(&s, hash);
+  expect_hash(impl->name, hash, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+static void test_against_portable (Impl* impl, const uint8_t* data) {
+  for(size_t len=0; len<300; len++){
+    uint8_t expected[32], hash[32];
+    compress = compress_portable;
+    calc_sha_256(expected, data, len);
+    compress = impl->fn;
+    calc_sha_256(hash, data, len);
+    if(memcmp(expected, hash, 32) != 0){
+      printf("FAIL %s: mismatch at length %zu\n", impl->name, len);
+      failures++;
+      return;
+    }
+  }
+}
+
+//Write nfiles files of varying lengths, hash them as a batch, and
+//compare against hashing each in memory.
+static void test_files (const uint8_t* data, const char* dir, int nfiles, size_t max_len) {
+  char** names = malloc(nfiles * sizeof(char*));
+  size_t* lens = malloc(nfiles * sizeof(size_t));
+  for(int i=0; i<nfiles; i++){
+    names[i] = malloc(strlen(dir) + 32);
+    sprintf(names[i], "%s/sha256-bench-%d.bin", dir, i);
+    lens[i] = ((size_t)i * 7919 * 131) % max_len;
+    FILE* f = fopen(names[i], "wb");
+    fwrite(data, 1, lens[i], f);
+    fclose(f);
+  }
+  uint8_t* hashes = malloc(32 * nfiles);
+  //Run once with the selected implementation, and once forcing the
+  //multi-buffer implementation if the machine supports it.
+  for(int pass=0; pass<2; pass++){
+    select_implementation();
+    if(pass == 1){
+#ifdef SHA_256_X86
+      if(!__builtin_cpu_supports("avx2")) break;
+      compress = compress_portable;
+      multi_buffer = 1;
+#else
+      break;
+#endif
+    }
+    long failed = sha_256_files(hashes, (const char**)names, nfiles);
+    if(failed >= 0){
+      printf("FAIL batch: could not read %s\n", names[failed]);
+      failures++;
+    }
+    for(int i=0; i<nfiles && failed < 0; i++){
+      uint8_t expected[32];
+      calc_sha_256(expected, data, lens[i]);
+      if(memcmp(expected, hashes + 32*i, 32) != 0){
+        printf("FAIL batch (pass %d): mismatch for file %d (length %zu)\n", pass, i, lens[i]);
+        failures++;
+      }
+    }
+  }
+  select_implementation();
+  for(int i=0; i<nfiles; i++){
+    remove(names[i]);
+    free(names[i]);
+  }
+  free(names);
+  free(lens);
+  free(hashes);
+}
+
+//============================================================
+//==================== Benchmarks ============================
+//============================================================
+
+static void bench_single (Impl* impl, const uint8_t* data, size_t len, int reps) {
+  uint8_t hash[32];
+  compress = impl->fn;
+  double t0 = now_s();
+  for(int i=0; i<reps; i++)
+    calc_sha_256(hash, data, len);
+  double t = now_s() - t0;
+  printf("%-12s %8.1f MB/s\n", impl->name, (double)len * reps / t / 1e6);
+}
+
+#ifdef SHA_256_X86
+static void bench_multi_buffer (const uint8_t* data, size_t len, int reps) {
+  uint32_t h[8][8];
+  uint32_t* hs[8];
+  const uint8_t* chunks[8];
+  size_t per_lane = (len / 8) / CHUNK_SIZE;
+  for(int i=0; i<8; i++){
+    memcpy(h[i], h0, sizeof(h0));
+    hs[i] = h[i];
+    chunks[i] = data + i * per_lane * CHUNK_SIZE;
+  }
+  double t0 = now_s();
+  for(int r=0; r<reps; r++)
+    compress_avx2_x8(hs, chunks, per_lane);
+  double t = now_s() - t0;
+  printf("%-12s %8.1f MB/s\n", "avx2-x8", (double)(8 * per_lane * CHUNK_SIZE) * reps / t / 1e6);
+}
+#endif
+
+//============================================================
+//======================== Main ==============================
+//============================================================
+
+int main (int argc, char** argv) {
+  const char* dir = argc > 1 ? argv[1] : ".";
+  size_t len = 64 * 1024 * 1024;
+  uint8_t* data = malloc(len);
+  fill_random(data, len);
+
+  detect_impls();
+  for(int i=0; i<nimpls; i++){
+    if(!impls[i].available) continue;
+    test_vectors(&impls[i]);
+    test_against_portable(&impls[i], data);
+  }
+  test_files(data, dir, 37, 200000);
+
+  printf("Throughput on %zu MB input:\n", len / (1024 * 1024));
+  for(int i=0; i<nimpls; i++)
+    if(impls[i].available)
+      bench_single(&impls[i], data, len, 4);
+#ifdef SHA_256_X86
+  if(__builtin_cpu_supports("avx2"))
+    bench_multi_buffer(data, len, 4);
+#endif
+
+  free(data);
+  if(failures > 0){
+    printf("%d failures.\n", failures);
+    return 1;
+  }
+  printf("All tests passed.\n");
+  return 0;
+}